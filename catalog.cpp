@@ -0,0 +1,272 @@
+/**********************************************************************
+ * Copyright (C) 2021 MX Authors
+ *
+ * Authors: MX Linux <http://mxlinux.org>
+ *
+ * This file is part of MX Tools.
+ *
+ * MX Tools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MX Tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MX Tools.  If not, see <http://www.gnu.org/licenses/>.
+ **********************************************************************/
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QSaveFile>
+
+#include "catalog.h"
+
+const QString Catalog::default_path = QStringLiteral("/usr/share/mx-tools/catalog.bin");
+const QStringList Catalog::categories {"MX-Live", "MX-Maintenance", "MX-Setup", "MX-Software", "MX-Utilities"};
+
+// Icon folders used when the icon is not found in the theme, the catalog is stale when any of them changes
+static const QStringList icon_dirs {"/usr/share/pixmaps/",
+                                    "/usr/local/share/icons/",
+                                    "/usr/share/icons/hicolor/48x48/apps/",
+                                    "/usr/share/icons/hicolor/",
+                                    "/usr/share/icons/"};
+
+static QDataStream &operator<<(QDataStream &out, const Catalog::Entry &entry)
+{
+    return out << entry.file_name << entry.categories << entry.names << entry.comments
+               << entry.icon_name << entry.icon_path << entry.exec << entry.terminal << entry.flags;
+}
+
+static QDataStream &operator>>(QDataStream &in, Catalog::Entry &entry)
+{
+    return in >> entry.file_name >> entry.categories >> entry.names >> entry.comments
+              >> entry.icon_name >> entry.icon_path >> entry.exec >> entry.terminal >> entry.flags;
+}
+
+// Pick the translation for the locale, falls back on the language without region
+static QString localized(const QMap<QString, QString> &values, const QString &lang_region)
+{
+    const QString lang = lang_region.section(QLatin1Char('_'), 0, 0);
+    QString value;
+    if (lang != QLatin1String("en")) {
+        value = values.value(lang_region);
+        if (value.isEmpty()) // check lang
+            value = values.value(lang);
+    }
+    if (lang_region == QLatin1String("pt_BR")) // not using Portuguese [pt] for Brazilian Portuguese [pt_BR]
+        value = values.value(lang_region);
+    return value;
+}
+
+QString Catalog::Entry::name(const QString &lang_region) const
+{
+    QString name = localized(names, lang_region);
+    if (name.isEmpty()) { // backup if Name is not translated
+        name = names.value(QString());
+        name = name.remove(QRegularExpression(QLatin1String("^MX "))).replace(QLatin1Char('&'), QLatin1String("&&"));
+    }
+    return name;
+}
+
+QString Catalog::Entry::comment(const QString &lang_region) const
+{
+    QString comment = localized(comments, lang_region);
+    if (comment.isEmpty()) // backup if Comment is not translated
+        comment = comments.value(QString());
+    return comment;
+}
+
+// Load the catalog with a single mmap, returns false if missing, unreadable or stale
+bool Catalog::load(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QFile::ReadOnly) || file.size() == 0)
+        return false;
+    uchar *data = file.map(0, file.size());
+    if (!data)
+        return false;
+
+    QByteArray bytes = QByteArray::fromRawData(reinterpret_cast<const char *>(data), static_cast<int>(file.size()));
+    QDataStream in(bytes);
+    in.setVersion(QDataStream::Qt_5_0);
+
+    quint32 file_magic = 0;
+    quint32 file_version = 0;
+    in >> file_magic >> file_version;
+    if (file_magic != magic || file_version != format_version) {
+        file.unmap(data);
+        return false;
+    }
+    QMap<QString, qint64> stamps;
+    in >> stamps;
+    const QMap<QString, qint64> current = currentStamps(stamps.keys());
+    if (stamps != current) {
+        file.unmap(data);
+        return false;
+    }
+    quint32 count = 0;
+    in >> count;
+    QHash<QString, Entry> loaded;
+    loaded.reserve(static_cast<int>(count));
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        Entry entry;
+        in >> entry;
+        loaded.insert(entry.file_name, entry);
+    }
+    const bool ok = (in.status() == QDataStream::Ok);
+    file.unmap(data);
+    if (!ok)
+        return false;
+    entries = loaded;
+    dir_stamps = stamps;
+    return true;
+}
+
+bool Catalog::save(const QString &path) const
+{
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile file(path);
+    if (!file.open(QFile::WriteOnly))
+        return false;
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_0);
+    out << magic << format_version << dir_stamps << static_cast<quint32>(entries.size());
+    for (const Entry &entry : entries)
+        out << entry;
+    if (out.status() != QDataStream::Ok) {
+        file.cancelWriting();
+        return false;
+    }
+    return file.commit();
+}
+
+// Read all .desktop files in the location that belong to one of the MX categories
+void Catalog::scan(const QString &location)
+{
+    entries.clear();
+    QDirIterator it(location, {"*.desktop"}, QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        Entry entry;
+        if (parseDesktopFile(it.next(), &entry))
+            entries.insert(entry.file_name, entry);
+    }
+    dir_stamps = currentStamps(QStringList(location) + icon_dirs);
+}
+
+void Catalog::resolveIcons()
+{
+    for (Entry &entry : entries)
+        entry.icon_path = resolveIconPath(entry.icon_name);
+}
+
+const Catalog::Entry *Catalog::entry(const QString &file_name) const
+{
+    auto it = entries.constFind(file_name);
+    return (it != entries.constEnd()) ? &it.value() : nullptr;
+}
+
+QStringList Catalog::listFiles(const QString &category) const
+{
+    QStringList list;
+    for (const Entry &entry : entries)
+        if (entry.categories.contains(category))
+            list << entry.file_name;
+    list.sort();
+    return list;
+}
+
+// Find the icon file outside of the icon theme, looking in the same places as MainWindow::findIcon
+QString Catalog::resolveIconPath(const QString &icon_name)
+{
+    if (icon_name.isEmpty())
+        return QString();
+    if (QFileInfo::exists("/" + icon_name))
+        return icon_name;
+
+    QString search_term = icon_name;
+    if (!icon_name.endsWith(".png") && !icon_name.endsWith(".svg") && !icon_name.endsWith(".xpm"))
+        search_term = icon_name + ".*";
+
+    QString name = icon_name;
+    name.remove(QRegularExpression(R"(\.png$|\.svg$|\.xpm$)"));
+
+    for (const QString &path : icon_dirs.mid(0, 3)) {
+        for (const QString &ext : {".png", ".svg", ".xpm"}) {
+            QString file = path + name + ext;
+            if (QFileInfo::exists(file))
+                return file;
+        }
+    }
+
+    // Search recursive
+    for (const QString &path : {"/usr/share/icons/hicolor/48x48/", "/usr/share/icons/hicolor/", "/usr/share/icons/"}) {
+        QDirIterator it(path, {search_term}, QDir::Files, QDirIterator::Subdirectories);
+        if (it.hasNext())
+            return it.next();
+    }
+    return QString();
+}
+
+QMap<QString, qint64> Catalog::currentStamps(const QStringList &dirs)
+{
+    QMap<QString, qint64> stamps;
+    for (const QString &dir : dirs) {
+        QFileInfo info(dir);
+        stamps.insert(dir, info.exists() ? info.lastModified().toMSecsSinceEpoch() : -1);
+    }
+    return stamps;
+}
+
+bool Catalog::parseDesktopFile(const QString &file_name, Entry *entry)
+{
+    QFile file(file_name);
+    if (!file.open(QFile::Text | QFile::ReadOnly))
+        return false;
+    const QString text = file.readAll();
+    file.close();
+
+    for (const QString &category : categories)
+        if (text.contains(category))
+            entry->categories << category;
+    if (entry->categories.isEmpty())
+        return false;
+
+    entry->file_name = file_name;
+    if (text.contains(QLatin1String("OnlyShowIn=XFCE")))
+        entry->flags |= OnlyXfce;
+    if (text.contains(QLatin1String("OnlyShowIn=FLUXBOX")))
+        entry->flags |= OnlyFluxbox;
+    if (text.contains(QLatin1String("MX-OnlyLive")))
+        entry->flags |= OnlyLive;
+    if (text.contains(QLatin1String("MX-OnlyInstalled")))
+        entry->flags |= OnlyInstalled;
+
+    // the first occurrence of a key wins, keys in later groups (e.g. actions) are ignored
+    static const QRegularExpression re(QLatin1String(R"(^(Name|Comment)(?:\[([^\]]+)\])?=(.*)$)"));
+    const QStringList lines = text.split(QLatin1Char('\n'));
+    for (const QString &line : lines) {
+        QRegularExpressionMatch match = re.match(line);
+        if (match.hasMatch()) {
+            QMap<QString, QString> &values = (match.captured(1) == QLatin1String("Name")) ? entry->names : entry->comments;
+            const QString locale = match.captured(2);
+            if (!values.contains(locale))
+                values.insert(locale, match.captured(3));
+        } else if (entry->exec.isNull() && line.startsWith(QLatin1String("Exec="))) {
+            entry->exec = line.mid(5);
+        } else if (entry->icon_name.isNull() && line.startsWith(QLatin1String("Icon="))) {
+            entry->icon_name = line.mid(5);
+        } else if (entry->terminal.isNull() && line.startsWith(QLatin1String("Terminal="))) {
+            entry->terminal = line.mid(9);
+        }
+    }
+    return true;
+}
@@ -0,0 +1,82 @@
+/**********************************************************************
+ * Copyright (C) 2021 MX Authors
+ *
+ * Authors: MX Linux <http://mxlinux.org>
+ *
+ * This file is part of MX Tools.
+ *
+ * MX Tools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MX Tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MX Tools.  If not, see <http://www.gnu.org/licenses/>.
+ **********************************************************************/
+
+#ifndef CATALOG_H
+#define CATALOG_H
+
+#include <QHash>
+#include <QMap>
+#include <QStringList>
+
+// Catalog of the MX tools .desktop files with all translations and resolved icon paths.
+// It is precomputed by mx-tools-catalog into catalog.bin (regenerated by a dpkg trigger)
+// so that on live systems mx-tools doesn't have to read every file through squashfs.
+class Catalog
+{
+public:
+    enum Flag {
+        OnlyXfce = 0x1,
+        OnlyFluxbox = 0x2,
+        OnlyLive = 0x4,
+        OnlyInstalled = 0x8
+    };
+
+    struct Entry {
+        QString file_name;
+        QStringList categories;
+        QMap<QString, QString> names;    // key is the locale, empty key for the untranslated value
+        QMap<QString, QString> comments;
+        QString icon_name;
+        QString icon_path;               // resolved by the generator, empty if not resolved
+        QString exec;
+        QString terminal;
+        quint32 flags = 0;
+
+        QString name(const QString &lang_region) const;
+        QString comment(const QString &lang_region) const;
+    };
+
+    static const QString default_path;
+    static const QStringList categories;
+
+    bool load(const QString &path);
+    bool save(const QString &path) const;
+    void scan(const QString &location);
+    void resolveIcons();
+
+    bool isEmpty() const { return entries.isEmpty(); }
+    const Entry *entry(const QString &file_name) const;
+    QStringList listFiles(const QString &category) const;
+
+    static QString resolveIconPath(const QString &icon_name);
+
+private:
+    static constexpr quint32 magic = 0x4d585443; // "MXTC"
+    static constexpr quint32 format_version = 1;
+
+    QHash<QString, Entry> entries;
+    QMap<QString, qint64> dir_stamps; // modification times of the directories the catalog was built from
+
+    static QMap<QString, qint64> currentStamps(const QStringList &dirs);
+    static bool parseDesktopFile(const QString &file_name, Entry *entry);
+};
+
+#endif // CATALOG_H
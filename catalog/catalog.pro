@@ -0,0 +1,39 @@
+# **********************************************************************
+# * Copyright (C) 2021 MX Authors
+# *
+# * Authors: MX Linux <http://mxlinux.org>
+# *
+# * This file is part of MX Tools.
+# *
+# * MX Tools is free software: you can redistribute it and/or modify
+# * it under the terms of the GNU General Public License as published by
+# * the Free Software Foundation, either version 3 of the License, or
+# * (at your option) any later version.
+# *
+# * MX Tools is distributed in the hope that it will be useful,
+# * but WITHOUT ANY WARRANTY; without even the implied warranty of
+# * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# * GNU General Public License for more details.
+# *
+# * You should have received a copy of the GNU General Public License
+# * along with MX Tools.  If not, see <http://www.gnu.org/licenses/>.
+# **********************************************************************
+
+# Generator for /usr/share/mx-tools/catalog.bin, run from the dpkg trigger
+
+QT       = core
+CONFIG   += c++1z console
+CONFIG   -= app_bundle
+
+TARGET = mx-tools-catalog
+TEMPLATE = app
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+INCLUDEPATH += ..
+
+SOURCES += main.cpp \
+    ../catalog.cpp
+
+HEADERS  += \
+    ../catalog.h
@@ -0,0 +1,41 @@
+/**********************************************************************
+ * Copyright (C) 2021 MX Authors
+ *
+ * Authors: MX Linux <http://mxlinux.org>
+ *
+ * This file is part of MX Tools.
+ *
+ * MX Tools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MX Tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MX Tools.  If not, see <http://www.gnu.org/licenses/>.
+ **********************************************************************/
+
+#include <QCoreApplication>
+#include <QDebug>
+
+#include "catalog.h"
+
+// Usage: mx-tools-catalog [output file], defaults to /usr/share/mx-tools/catalog.bin
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    const QString path = app.arguments().value(1, Catalog::default_path);
+
+    Catalog catalog;
+    catalog.scan("/usr/share/applications");
+    catalog.resolveIcons();
+    if (!catalog.save(path)) {
+        qWarning().noquote() << "Could not write catalog:" << path;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,155 @@
+/**********************************************************************
+ * Copyright (C) 2021 MX Authors
+ *
+ * Authors: MX Linux <http://mxlinux.org>
+ *
+ * This file is part of MX Tools.
+ *
+ * MX Tools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MX Tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MX Tools.  If not, see <http://www.gnu.org/licenses/>.
+ **********************************************************************/
+
+#include <QDir>
+#include <QFile>
+#include <QThread>
+
+#include <cstring>
+
+#include "dpkgindex.h"
+
+DpkgIndex::DpkgIndex(const QStringList &prefixes, const QString &admin_dir, QObject *parent)
+    : QObject(parent),
+      admin_dir(admin_dir)
+{
+    for (const QString &prefix : prefixes)
+        this->prefixes << QFile::encodeName(prefix);
+}
+
+DpkgIndex::~DpkgIndex()
+{
+    if (worker) {
+        worker->wait();
+        delete worker;
+    }
+}
+
+// Build the index on a worker thread, the first call starts it and later calls do nothing
+void DpkgIndex::load()
+{
+    if (worker || ready)
+        return;
+    worker = QThread::create([this] {
+        readLists();
+        if (!owners.isEmpty())
+            readStatus();
+    });
+    connect(worker, &QThread::finished, this, [this] {
+        worker->deleteLater();
+        worker = nullptr;
+        ready = true;
+        emit loaded();
+    });
+    worker->start(QThread::LowPriority);
+}
+
+// Return the installed package that owns the path, empty name if none or not loaded yet
+DpkgIndex::Package DpkgIndex::owner(const QString &path) const
+{
+    if (!ready)
+        return Package();
+    const QByteArray key = owners.value(QFile::encodeName(path));
+    return key.isEmpty() ? Package() : packages.value(key);
+}
+
+// Each info/<package>[:<arch>].list file holds the paths installed by the package, one per line
+void DpkgIndex::readLists()
+{
+    const QString info_dir = admin_dir + "/info/";
+    const QStringList list_files = QDir(info_dir).entryList({"*.list"}, QDir::Files);
+    for (const QString &list_file : list_files) {
+        QFile file(info_dir + list_file);
+        if (!file.open(QFile::ReadOnly) || file.size() == 0)
+            continue;
+        const qint64 size = file.size();
+        uchar *map = file.map(0, size);
+        if (!map)
+            continue;
+        const char *data = reinterpret_cast<const char *>(map);
+        const QByteArray package = QFile::encodeName(list_file.chopped(5));
+        const char *end = data + size;
+        for (const char *line = data; line < end;) {
+            const char *eol = static_cast<const char *>(memchr(line, '\n', static_cast<size_t>(end - line)));
+            if (!eol)
+                eol = end;
+            const int len = static_cast<int>(eol - line);
+            bool wanted = prefixes.isEmpty();
+            for (const QByteArray &prefix : qAsConst(prefixes)) {
+                if (len >= prefix.size() && memcmp(line, prefix.constData(), static_cast<size_t>(prefix.size())) == 0) {
+                    wanted = true;
+                    break;
+                }
+            }
+            if (wanted)
+                owners.insert(QByteArray(line, len), package);
+            line = eol + 1;
+        }
+        file.unmap(map);
+    }
+}
+
+// The status file is a list of RFC 822 style paragraphs separated by empty lines
+void DpkgIndex::readStatus()
+{
+    QFile file(admin_dir + "/status");
+    if (!file.open(QFile::ReadOnly) || file.size() == 0)
+        return;
+    const qint64 size = file.size();
+    uchar *map = file.map(0, size);
+    if (!map)
+        return;
+    const char *data = reinterpret_cast<const char *>(map);
+
+    Package package;
+    bool installed = false;
+    auto commit = [&]() {
+        if (installed && !package.name.isEmpty()) {
+            const QByteArray name = package.name.toUtf8();
+            packages.insert(name, package);
+            packages.insert(name + ':' + package.architecture.toUtf8(), package);
+        }
+        package = Package();
+        installed = false;
+    };
+
+    const char *end = data + size;
+    for (const char *line = data; line < end;) {
+        const char *eol = static_cast<const char *>(memchr(line, '\n', static_cast<size_t>(end - line)));
+        if (!eol)
+            eol = end;
+        const QByteArray field = QByteArray::fromRawData(line, static_cast<int>(eol - line));
+        if (field.isEmpty()) {
+            commit();
+        } else if (field.startsWith("Package: ")) {
+            package.name = QString::fromUtf8(field.mid(9));
+        } else if (field.startsWith("Version: ")) {
+            package.version = QString::fromUtf8(field.mid(9));
+        } else if (field.startsWith("Architecture: ")) {
+            package.architecture = QString::fromUtf8(field.mid(14));
+        } else if (field.startsWith("Status: ")) {
+            installed = field.endsWith(" installed");
+        }
+        line = eol + 1;
+    }
+    commit();
+    file.unmap(map);
+}
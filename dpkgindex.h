@@ -0,0 +1,71 @@
+/**********************************************************************
+ * Copyright (C) 2021 MX Authors
+ *
+ * Authors: MX Linux <http://mxlinux.org>
+ *
+ * This file is part of MX Tools.
+ *
+ * MX Tools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MX Tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MX Tools.  If not, see <http://www.gnu.org/licenses/>.
+ **********************************************************************/
+
+#ifndef DPKGINDEX_H
+#define DPKGINDEX_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QObject>
+#include <QStringList>
+
+class QThread;
+
+// In-process replacement for "dpkg -S": maps the dpkg status file and info/*.list files
+// and indexes which installed package owns a path. Nothing is read until load() is called,
+// the index is built on a worker thread and loaded() is emitted when it can be queried.
+class DpkgIndex : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Package {
+        QString name;
+        QString version;
+        QString architecture;
+    };
+
+    // only paths starting with one of the prefixes are indexed, all paths if empty
+    explicit DpkgIndex(const QStringList &prefixes = QStringList(), const QString &admin_dir = "/var/lib/dpkg",
+                       QObject *parent = nullptr);
+    ~DpkgIndex();
+
+    bool isLoaded() const { return ready; }
+    void load();
+    Package owner(const QString &path) const;
+
+signals:
+    void loaded();
+
+private:
+    QString admin_dir;
+    QList<QByteArray> prefixes;
+    QThread *worker = nullptr;
+    bool ready = false;
+    // written by the worker only, read after loaded()
+    QHash<QByteArray, Package> packages;   // keyed by "name" and "name:arch"
+    QHash<QByteArray, QByteArray> owners;  // path -> package key
+
+    void readLists();
+    void readStatus();
+};
+
+#endif // DPKGINDEX_H
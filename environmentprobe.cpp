@@ -0,0 +1,114 @@
+/**********************************************************************
+ * Copyright (C) 2021 MX Authors
+ *
+ * Authors: MX Linux <http://mxlinux.org>
+ *
+ * This file is part of MX Tools.
+ *
+ * MX Tools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MX Tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MX Tools.  If not, see <http://www.gnu.org/licenses/>.
+ **********************************************************************/
+
+#include <QFile>
+
+#include <sys/statfs.h>
+
+#include "environmentprobe.h"
+
+// Filesystem magic numbers from linux/magic.h (aufs is out of tree)
+static const struct {
+    unsigned long magic;
+    const char *name;
+} fs_magic[] {
+    {0x61756673, "aufs"},
+    {0x794c7630, "overlay"},
+    {0x73717368, "squashfs"},
+    {0x01021994, "tmpfs"},
+    {0x858458f6, "ramfs"},
+    {0xef53,     "ext4"},  // ext2/3/4 share the magic number, df reports the mounted type
+    {0x9123683e, "btrfs"},
+    {0x58465342, "xfs"},
+    {0x52654973, "reiserfs"},
+    {0x3153464a, "jfs"},
+    {0xf2f52010, "f2fs"},
+};
+
+const EnvironmentProbe &EnvironmentProbe::instance()
+{
+    static const EnvironmentProbe probe;
+    return probe;
+}
+
+EnvironmentProbe::EnvironmentProbe()
+{
+    root_fs_type = fsTypeFromStatfs("/");
+    if (root_fs_type.isEmpty() || root_fs_type == QLatin1String("ext4"))
+        root_fs_type = fsTypeFromMountInfo("/");
+    live = (root_fs_type == QLatin1String("aufs") || root_fs_type == QLatin1String("overlay"));
+
+    if (live) {
+        QFile file("/proc/cmdline");
+        if (file.open(QFile::ReadOnly)) {
+            const QList<QByteArray> params = file.readAll().simplified().split(' ');
+            for (const QByteArray &param : params) {
+                if (param == "toram" || param.startsWith("toram="))
+                    toram = true;
+                else if (param.startsWith("persist") || param.startsWith("p_static_root") || param.startsWith("frugal"))
+                    persistence = true;
+            }
+        }
+    }
+
+    // XDG_CURRENT_DESKTOP is a colon-separated list, e.g. "X-Cinnamon:GNOME"
+    const QString current = QString::fromLocal8Bit(qgetenv("XDG_CURRENT_DESKTOP"));
+    desktop_list = current.split(QLatin1Char(':'), Qt::SkipEmptyParts);
+    const QString session = QString::fromLocal8Bit(qgetenv("XDG_SESSION_DESKTOP"));
+    if (!session.isEmpty() && !desktop_list.contains(session, Qt::CaseInsensitive))
+        desktop_list << session;
+}
+
+bool EnvironmentProbe::isDesktop(const QString &name) const
+{
+    return desktop_list.contains(name, Qt::CaseInsensitive);
+}
+
+QString EnvironmentProbe::fsTypeFromStatfs(const QString &path)
+{
+    struct statfs buf {};
+    if (statfs(QFile::encodeName(path).constData(), &buf) != 0)
+        return QString();
+    for (const auto &fs : fs_magic)
+        if (static_cast<unsigned long>(buf.f_type) == fs.magic)
+            return QLatin1String(fs.name);
+    return QString();
+}
+
+// Fields: ID parentID major:minor root mount_point options [optional...] - fstype source super_options
+QString EnvironmentProbe::fsTypeFromMountInfo(const QString &mount_point)
+{
+    QFile file("/proc/self/mountinfo");
+    if (!file.open(QFile::ReadOnly))
+        return QString();
+    const QByteArray target = QFile::encodeName(mount_point);
+    QString fs_type;
+    const QList<QByteArray> lines = file.readAll().split('\n');
+    for (const QByteArray &line : lines) {
+        const QList<QByteArray> fields = line.split(' ');
+        if (fields.size() < 7 || fields.at(4) != target)
+            continue;
+        const int sep = fields.indexOf("-");
+        if (sep > 0 && sep + 1 < fields.size())
+            fs_type = QString::fromLatin1(fields.at(sep + 1)); // last mount over the point wins
+    }
+    return fs_type;
+}
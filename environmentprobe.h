@@ -0,0 +1,54 @@
+/**********************************************************************
+ * Copyright (C) 2021 MX Authors
+ *
+ * Authors: MX Linux <http://mxlinux.org>
+ *
+ * This file is part of MX Tools.
+ *
+ * MX Tools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MX Tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MX Tools.  If not, see <http://www.gnu.org/licenses/>.
+ **********************************************************************/
+
+#ifndef ENVIRONMENTPROBE_H
+#define ENVIRONMENTPROBE_H
+
+#include <QStringList>
+
+// Detects the running environment (live or installed, desktop session) without spawning processes.
+// Everything is probed once on first use and cached for the rest of the run.
+class EnvironmentProbe
+{
+public:
+    static const EnvironmentProbe &instance();
+
+    QString rootFsType() const { return root_fs_type; }
+    QStringList desktops() const { return desktop_list; }
+    bool hasPersistence() const { return persistence; }
+    bool isDesktop(const QString &name) const;
+    bool isLive() const { return live; }
+    bool isToRam() const { return toram; }
+
+private:
+    EnvironmentProbe();
+
+    QString root_fs_type;
+    QStringList desktop_list;
+    bool live = false;
+    bool persistence = false;
+    bool toram = false;
+
+    static QString fsTypeFromMountInfo(const QString &mount_point);
+    static QString fsTypeFromStatfs(const QString &path);
+};
+
+#endif // ENVIRONMENTPROBE_H
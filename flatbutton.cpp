@@ -36,10 +36,20 @@ FlatButton::FlatButton(const QString& name, QWidget *parent)
     setStyleSheet("text-align:left");
 }
 
+bool FlatButton::event(QEvent *e)
+{
+    if (e->type() == QEvent::ToolTip && !tooltip_requested) {
+        tooltip_requested = true;
+        emit toolTipRequested();
+    }
+    return QPushButton::event(e);
+}
+
 void FlatButton::leaveEvent(QEvent * e)
 {
     //setFlat(true);
     setStyleSheet("text-align:left; text-decoration:none");
+    emit highlightChanged(false);
     QPushButton::leaveEvent(e);
 }
 
@@ -47,9 +57,22 @@ void FlatButton::enterEvent(QEvent *e)
 {
     //setFlat(false);
     setStyleSheet("QPushButton { text-align:left; text-decoration:underline}; QToolTip { text-decoration: none; }");
+    emit highlightChanged(true);
     QPushButton::enterEvent(e);
 }
 
+void FlatButton::focusInEvent(QFocusEvent *e)
+{
+    emit highlightChanged(true);
+    QPushButton::focusInEvent(e);
+}
+
+void FlatButton::focusOutEvent(QFocusEvent *e)
+{
+    emit highlightChanged(false);
+    QPushButton::focusOutEvent(e);
+}
+
 void FlatButton::setIconSize(int x, int y)
 {
     QPushButton::setIconSize(QSize(x, y));
@@ -35,10 +35,17 @@ public:
     FlatButton(const QString& name, QWidget *parent = nullptr);
     void setIconSize(int, int);
     void setIconSize(QSize size);
+signals:
+    void highlightChanged(bool on); // pointer or keyboard focus entered (true) or left (false)
+    void toolTipRequested(); // emitted before the first tooltip is shown, so it can be filled lazily
 protected:
+    bool event(QEvent *e);
     void enterEvent(QEvent *e);
+    void focusInEvent(QFocusEvent *e);
+    void focusOutEvent(QFocusEvent *e);
     void leaveEvent(QEvent *e);
-
+private:
+    bool tooltip_requested = false;
 };
 
 #endif // FLATBUTTON_H
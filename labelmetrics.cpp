@@ -0,0 +1,63 @@
+/**********************************************************************
+ * Copyright (C) 2021 MX Authors
+ *
+ * Authors: MX Linux <http://mxlinux.org>
+ *
+ * This file is part of MX Tools.
+ *
+ * MX Tools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MX Tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MX Tools.  If not, see <http://www.gnu.org/licenses/>.
+ **********************************************************************/
+
+#include <QLocale>
+
+#include "labelmetrics.h"
+
+LabelMetrics::LabelMetrics()
+    : metrics(QFont())
+{
+}
+
+// Use the font for measuring, returns true if it differs from the previous font or locale
+bool LabelMetrics::setFont(const QFont &font)
+{
+    const QString new_key = font.key() + QLatin1Char('|') + QLocale().name();
+    if (new_key == key)
+        return false;
+    key = new_key;
+    metrics = QFontMetrics(font);
+    widths.clear();
+    elided_texts.clear();
+    return true;
+}
+
+int LabelMetrics::width(const QString &text)
+{
+    auto it = widths.constFind(text);
+    if (it != widths.constEnd())
+        return it.value();
+    const int width = metrics.horizontalAdvance(text);
+    widths.insert(text, width);
+    return width;
+}
+
+QString LabelMetrics::elided(const QString &text, int width)
+{
+    const QString elided_key = QString::number(width) + QLatin1Char(':') + text;
+    auto it = elided_texts.constFind(elided_key);
+    if (it != elided_texts.constEnd())
+        return it.value();
+    const QString elided_text = metrics.elidedText(text, Qt::ElideRight, width);
+    elided_texts.insert(elided_key, elided_text);
+    return elided_text;
+}
@@ -0,0 +1,47 @@
+/**********************************************************************
+ * Copyright (C) 2021 MX Authors
+ *
+ * Authors: MX Linux <http://mxlinux.org>
+ *
+ * This file is part of MX Tools.
+ *
+ * MX Tools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MX Tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MX Tools.  If not, see <http://www.gnu.org/licenses/>.
+ **********************************************************************/
+
+#ifndef LABELMETRICS_H
+#define LABELMETRICS_H
+
+#include <QFont>
+#include <QFontMetrics>
+#include <QHash>
+
+// Caches label widths and elided labels so relayouts on resize or search don't measure text again.
+// The caches are kept for one font and locale and dropped when either changes.
+class LabelMetrics
+{
+public:
+    LabelMetrics();
+
+    bool setFont(const QFont &font);
+    int width(const QString &text);
+    QString elided(const QString &text, int width);
+
+private:
+    QString key;
+    QFontMetrics metrics;
+    QHash<QString, int> widths;
+    QHash<QString, QString> elided_texts; // keyed by "<width>:<text>"
+};
+
+#endif // LABELMETRICS_H
@@ -20,6 +20,7 @@
  * along with MX Tools.  If not, see <http://www.gnu.org/licenses/>.
  **********************************************************************/
 
+#include <QCursor>
 #include <QDebug>
 #include <QDir>
 #include <QFile>
@@ -27,10 +28,14 @@
 #include <QRegularExpression>
 #include <QResizeEvent>
 #include <QScreen>
+#include <QScrollBar>
+#include <QStyle>
 #include <QTextEdit>
+#include <QToolTip>
 
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
+#include "environmentprobe.h"
 #include "flatbutton.h"
 #include "version.h"
 
@@ -43,15 +48,18 @@ MainWindow::MainWindow(QWidget *parent) :
     setConnections();
     setWindowFlags(Qt::Window); // for the close, min and max buttons
     // detect if tools are displayed in the menu (check for only one since all are set at the same time)
-    if (system("grep -q \"NoDisplay=true\" /home/$USER/.local/share/applications/mx-user.desktop >/dev/null 2>&1") == 0)
+    QFile user_file(QDir::homePath() + "/.local/share/applications/mx-user.desktop");
+    if (user_file.open(QFile::ReadOnly) && user_file.readAll().contains("NoDisplay=true"))
         ui->checkHide->setChecked(true);
 
     QString search_folder = "/usr/share/applications";
-    live_list = listDesktopFiles("MX-Live", search_folder);
-    maintenance_list = listDesktopFiles("MX-Maintenance", search_folder);
-    setup_list = listDesktopFiles("MX-Setup", search_folder);
-    software_list = listDesktopFiles("MX-Software", search_folder);
-    utilities_list = listDesktopFiles("MX-Utilities", search_folder);
+    if (!catalog.load(Catalog::default_path))
+        catalog.scan(search_folder);
+    live_list = catalog.listFiles("MX-Live");
+    maintenance_list = catalog.listFiles("MX-Maintenance");
+    setup_list = catalog.listFiles("MX-Setup");
+    software_list = catalog.listFiles("MX-Software");
+    utilities_list = catalog.listFiles("MX-Utilities");
 
     QVector<QStringList *> lists {
                 &live_list,
@@ -60,10 +68,10 @@ MainWindow::MainWindow(QWidget *parent) :
                 &software_list,
                 &utilities_list };
 
-    QString test = getCmdOut("df -T / |tail -n1 |awk '{print $2}'");
+    const EnvironmentProbe &env = EnvironmentProbe::instance();
 
     // remove mx-remastercc and live-kernel-updater from list if not running Live
-    bool live = (test == "aufs" || test == "overlay");
+    bool live = env.isLive();
     if (!live) {
         const QStringList live_list_copy = live_list;
         for (const QString &item : live_list_copy)
@@ -75,12 +83,12 @@ MainWindow::MainWindow(QWidget *parent) :
         removeEnvExclusive(*list, live);
 
     // remove item from list if it is only meant for XFCE
-    if (qgetenv("XDG_CURRENT_DESKTOP") != "XFCE")
+    if (!env.isDesktop("XFCE"))
         for (auto &list : lists)
             removeXfceOnly(*list);
 
     // remove item from list if it is only meant for FLUXBOX
-    if (qgetenv("XDG_SESSION_DESKTOP") != "fluxbox")
+    if (!env.isDesktop("fluxbox"))
         for (auto &list : lists)
             removeFLUXBOXonly(*list);
 
@@ -90,6 +98,10 @@ MainWindow::MainWindow(QWidget *parent) :
     category_map.insert("MX-Software", software_list);
     category_map.insert("MX-Utilities", utilities_list);
 
+    frequent_count = settings.value("frequent_count", frequent_count).toInt();
+    icon_size = settings.value("icon_size", icon_size).toInt();
+    usage.load(QFileInfo(settings.fileName()).absolutePath() + "/mx-tools.usage");
+
     readInfo(category_map);
     addButtons(info_map);
     ui->textSearch->setFocus();
@@ -103,7 +115,6 @@ MainWindow::MainWindow(QWidget *parent) :
         int y = (screenGeometry.height() - this->height()) / 2;
         this->move(x, y);
     }
-    icon_size = settings.value("icon_size", icon_size).toInt();
 }
 
 MainWindow::~MainWindow()
@@ -113,6 +124,7 @@ MainWindow::~MainWindow()
 
 void MainWindow::setConnections()
 {
+    connect(&dpkg_index, &DpkgIndex::loaded, this, &MainWindow::addPendingPackageToolTips);
     connect(ui->pushAbout, &QPushButton::clicked, this, &MainWindow::pushAbout_clicked);
     connect(ui->pushHelp, &QPushButton::clicked, this, &MainWindow::pushHelp_clicked);
     connect(ui->checkHide, &QCheckBox::clicked, this, &MainWindow::checkHide_clicked);
@@ -131,83 +143,25 @@ QString MainWindow::getCmdOut(const QString &cmd)
     return result;
 }
 
-// List .desktop files that contain a specific string
-QStringList MainWindow::listDesktopFiles(const QString &search_string, const QString &location)
-{
-    QStringList listDesktop;
-    QString cmd = QString("grep -Elr %1 %2 | sort").arg(search_string, location);
-    QString out = getCmdOut(cmd);
-    if (!out.isEmpty())
-        listDesktop = out.split("\n");
-    return listDesktop;
-}
-
-// Load info (name, comment, exec, icon_name, category, terminal) to the info_map
+// Load info (name, comment, exec, icon_name, category, terminal, icon_path) to the info_map
 void MainWindow::readInfo(const QMultiMap<QString, QStringList> &category_map)
 {
-    QString name;
-    QString comment;
-    QString exec;
-    QString icon_name;
-    QString terminal_switch;
     QStringList list;
-    QLocale locale;
-    QString lang = locale.name().split('_').first();
-    QString lang_region = locale.name();
+    const QString lang_region = QLocale().name();
     QMultiMap<QString, QStringList> map;
 
-    QRegularExpression re;
-    re.setPatternOptions(QRegularExpression::MultilineOption);
     QMapIterator<QString, QStringList> it(category_map);
     QString category;
     while (it.hasNext()) {
         category = it.next().key();
         list = category_map.value(category);
         for (const QString &file_name : qAsConst(list)) {
-            QFile file(file_name);
-            if (!file.open(QFile::Text | QFile::ReadOnly))
+            const Catalog::Entry *entry = catalog.entry(file_name);
+            if (!entry)
                 continue;
-            QString text = file.readAll();
-            file.close();
-            name.clear();
-            comment.clear();
-            if (lang != QLatin1String("en")) {
-                re.setPattern(QLatin1String("^Name\\[") + lang_region + QLatin1String("\\]=(.*)$"));
-                name = re.match(text).captured(1);
-                if (name.isEmpty()) { // check lang
-                    re.setPattern(QLatin1String("^Name\\[") + lang + QLatin1String("\\]=(.*)$"));
-                    name = re.match(text).captured(1);
-                }
-                re.setPattern(QLatin1String("^Comment\\[") + lang_region + QLatin1String("\\]=(.*)$"));
-                comment = re.match(text).captured(1);
-                if (comment.isEmpty()) { // check lang
-                    re.setPattern(QLatin1String("^Comment\\[") + lang + QLatin1String("\\]=(.*)$"));
-                    comment = re.match(text).captured(1);
-                }
-            }
-            if (lang_region == QLatin1String("pt_BR")) { // not using Portuguese [pt] for Brazilian Portuguese [pt_BR]
-                re.setPattern(QLatin1String("^Name\\[") + lang_region + QLatin1String("\\]=(.*)$"));
-                name = re.match(text).captured(1);
-                re.setPattern(QLatin1String("^Comment\\[") + lang_region + QLatin1String("\\]=(.*)$"));
-                comment = re.match(text).captured(1);
-            }
-            if (name.isEmpty()) { // backup if Name is not translated
-                re.setPattern(QLatin1String("^Name=(.*)$"));
-                name = re.match(text).captured(1);
-                name = name.remove(QRegularExpression(QLatin1String("^MX "))).replace(QLatin1Char('&'), QLatin1String("&&"));
-            }
-            if (comment.isEmpty()) { // backup if Comment is not translated
-                re.setPattern(QLatin1String("^Comment=(.*)$"));
-                comment = re.match(text).captured(1);
-            }
-            re.setPattern(QLatin1String("^Exec=(.*)$"));
-            exec = re.match(text).captured(1);
-            re.setPattern(QLatin1String("^Icon=(.*)$"));
-            icon_name = re.match(text).captured(1);
-            re.setPattern(QLatin1String("^Terminal=(.*)$"));
-            terminal_switch = re.match(text).captured(1);
             QStringList info;
-            map.insert(file_name, info << name << comment << icon_name << exec << category << terminal_switch);
+            map.insert(file_name, info << entry->name(lang_region) << entry->comment(lang_region) << entry->icon_name
+                       << entry->exec << category << entry->terminal << entry->icon_path);
         }
         info_map.insert(category, map);
         map.clear();
@@ -219,84 +173,201 @@ void MainWindow::addButtons(const QMultiMap<QString, QMultiMap<QString, QStringL
 {
     int col = 0;
     int row = 0;
-    const int max  = this->width() / 200;
 
     max_elements = 0;
+    QStringList file_names;
+    QStringList names;
     QMapIterator<QString, QMultiMap<QString, QStringList>> it(info_map);
     QString category;
     while (it.hasNext()) {
         category = it.next().key();
         if (info_map.value(category).keys().count() > max_elements)
             max_elements = info_map.value(category).keys().count();
+        file_names << info_map.value(category).keys();
+        for (const QStringList &file_info : info_map.value(category))
+            names << file_info.at(Info::Name);
+    }
+    col_width = columnWidth(names);
+    const int max = columnCount();
+
+    // most used tools first, this also ranks the search results
+    const QStringList frequent_list = usage.top(file_names, frequent_count);
+    if (!frequent_list.isEmpty()) {
+        max_elements = qMax(max_elements, frequent_list.count());
+        addSectionLabel(tr("Frequently used"), row);
+        for (const QString &file_name : frequent_list) {
+            it.toFront();
+            while (it.hasNext()) {
+                category = it.next().key();
+                if (info_map.value(category).contains(file_name)) {
+                    addButton(file_name, info_map.value(category).value(file_name), row, col, max);
+                    break;
+                }
+            }
+        }
     }
-
-    QString name;
-    QString comment;
-    QString exec;
-    QString icon_name;
-    QString terminal_switch;
 
     it.toFront();
     while (it.hasNext()) {
         category = it.next().key();
         if (!info_map.value(category).isEmpty()) {
-            // add empty row and delimiter except for the first row
-            if (row != 0) {
-                ++row;
-                auto *line = new QFrame();
-                line->setFrameShape(QFrame::HLine);
-                line->setFrameShadow(QFrame::Sunken);
-                ui->gridLayout_btn->addWidget(line, row, 0, 1, -1);
-            }
-            auto *label = new QLabel();
-            QFont font;
-            font.setBold(true);
-            font.setUnderline(true);
-            label->setFont(font);
             QString label_txt = category;
             label_txt.remove(QRegularExpression("^MX-"));
-            label->setText(label_txt);
-            ++row;
-            ui->gridLayout_btn->addWidget(label, row, 0);
-            ++row;
+            addSectionLabel(label_txt, row);
             col = 0;
             QMapIterator<QString, QStringList> it(info_map.value(category));
             QString file_name;
             while (it.hasNext()) {
                 file_name = it.next().key();
-                if (col >= col_count)
-                    col_count = col + 1;
-                QStringList file_info = info_map.value(category).value(file_name);
-                name = file_info.at(Info::Name);
-                comment = file_info.at(Info::Comment);
-                icon_name = file_info.at(Info::IconName);
-                exec = file_info.at(Info::Exec);
-                terminal_switch = file_info.at(Info::Terminal);
-                btn = new FlatButton(name);
-                btn->setToolTip(comment);
-                btn->setAutoDefault(false);
-                btn->setIcon(findIcon(icon_name));
-                btn->setIconSize(icon_size, icon_size);
-                ui->gridLayout_btn->addWidget(btn, row, col);
-                //ui->gridLayout_btn->setRowStretch(row, 0);
-                ++col;
-                if (col >= max) {
-                    col = 0;
-                    ++row;
-                }
-                QString cmd = "x-terminal-emulator -e ";
-                if (terminal_switch == "true")
-                    btn->setObjectName(cmd + exec); // add the command to be executed to the object name
-                else
-                    btn->setObjectName(exec); // add the command to be executed to the object name
-                QObject::connect(btn, &FlatButton::clicked, this, &MainWindow::btn_clicked);
+                addButton(file_name, info_map.value(category).value(file_name), row, col, max);
             }
         }
     }
     ui->gridLayout_btn->setRowStretch(row + 2, 1);
 }
 
-QIcon MainWindow::findIcon(QString icon_name)
+// Width of the widest button in a single pass over the cached label widths, capped at max_col_width
+int MainWindow::columnWidth(const QStringList &names)
+{
+    // the padding (icon, spacing and margins) only depends on the font and the icon size
+    if (label_metrics.setFont(QApplication::font("QPushButton")) || button_padding < 0) {
+        const QString sample_text(40, QLatin1Char('x'));
+        FlatButton sample(sample_text);
+        QPixmap pixmap(icon_size, icon_size);
+        pixmap.fill(Qt::transparent);
+        sample.setIcon(QIcon(pixmap));
+        sample.setIconSize(icon_size, icon_size);
+        button_padding = sample.sizeHint().width() - label_metrics.width(sample_text);
+    }
+    int width = 0;
+    for (const QString &name : names)
+        width = qMax(width, label_metrics.width(QString(name).replace("&&", "&")));
+    return qMin(button_padding + width, max_col_width);
+}
+
+// Number of columns that fit in the window with the current column width
+int MainWindow::columnCount() const
+{
+    const int spacing = qMax(ui->gridLayout_btn->horizontalSpacing(), 0);
+    return qMax(1, (buttonAreaWidth() + spacing) / (col_width + spacing));
+}
+
+// Window width minus the layout margins, frames and vertical scrollbar around the buttons
+int MainWindow::buttonAreaWidth() const
+{
+    const QList<QLayout *> layouts {ui->gridLayout, ui->gridLayout_2, ui->verticalLayout};
+    int chrome = 0;
+    for (const QLayout *layout : layouts) {
+        const QMargins margins = layout->contentsMargins();
+        chrome += margins.left() + margins.right();
+    }
+    chrome += 2 * (ui->frame->frameWidth() + ui->scrollArea->frameWidth());
+    chrome += style()->pixelMetric(QStyle::PM_ScrollBarExtent, nullptr, ui->scrollArea->verticalScrollBar());
+    return this->width() - chrome;
+}
+
+// add category label, with empty row and delimiter except for the first row
+void MainWindow::addSectionLabel(const QString &text, int &row)
+{
+    if (row != 0) {
+        ++row;
+        auto *line = new QFrame();
+        line->setFrameShape(QFrame::HLine);
+        line->setFrameShadow(QFrame::Sunken);
+        ui->gridLayout_btn->addWidget(line, row, 0, 1, -1);
+    }
+    auto *label = new QLabel();
+    QFont font;
+    font.setBold(true);
+    font.setUnderline(true);
+    label->setFont(font);
+    label->setText(text);
+    ++row;
+    ui->gridLayout_btn->addWidget(label, row, 0);
+    ++row;
+}
+
+// add the button at row/col and move to the next cell, wrapping after max columns
+void MainWindow::addButton(const QString &file_name, const QStringList &file_info, int &row, int &col, int max)
+{
+    if (col >= col_count)
+        col_count = col + 1;
+    const QString name = file_info.at(Info::Name);
+    const QString comment = file_info.at(Info::Comment);
+    const QString icon_name = file_info.at(Info::IconName);
+    const QString exec = file_info.at(Info::Exec);
+    const QString terminal_switch = file_info.at(Info::Terminal);
+    const QString icon_path = file_info.at(Info::IconPath);
+    // elide names that don't fit the column, '&&' is the escaped '&' of the button text
+    QString label = name;
+    QString tooltip = comment;
+    const QString plain_name = QString(name).replace("&&", "&");
+    if (button_padding + label_metrics.width(plain_name) > col_width) {
+        label = label_metrics.elided(plain_name, col_width - button_padding).replace('&', "&&");
+        tooltip = comment.isEmpty() ? plain_name : plain_name + "\n" + comment;
+    }
+    btn = new FlatButton(label);
+    btn->setAccessibleName(plain_name);
+    btn->setToolTip(tooltip);
+    btn->setAutoDefault(false);
+    btn->setIcon(findIcon(icon_name, icon_path));
+    btn->setIconSize(icon_size, icon_size);
+    btn->setProperty("file_name", file_name);
+    ui->gridLayout_btn->addWidget(btn, row, col);
+    ++col;
+    if (col >= max) {
+        col = 0;
+        ++row;
+    }
+    QString cmd = "x-terminal-emulator -e ";
+    if (terminal_switch == "true")
+        btn->setObjectName(cmd + exec); // add the command to be executed to the object name
+    else
+        btn->setObjectName(exec); // add the command to be executed to the object name
+    QObject::connect(btn, &FlatButton::clicked, this, &MainWindow::btn_clicked);
+    // warm up the tool's binary and libraries while the pointer or focus is on it
+    QObject::connect(btn, &FlatButton::highlightChanged, this, [this, exec](bool on) {
+        if (on)
+            prefetcher.request(exec);
+        else
+            prefetcher.cancel();
+    });
+    FlatButton *button = btn;
+    QObject::connect(btn, &FlatButton::toolTipRequested, this, [this, button, file_name] {
+        addPackageToolTip(button, file_name);
+    });
+}
+
+// Append the owning package and its version to the tooltip, looked up on first hover.
+// Until the index is built in the background the tooltip shows only the comment.
+void MainWindow::addPackageToolTip(FlatButton *button, const QString &file_name)
+{
+    if (!dpkg_index.isLoaded()) {
+        pending_tooltips << qMakePair(QPointer<FlatButton>(button), file_name);
+        dpkg_index.load();
+        return;
+    }
+    const DpkgIndex::Package package = dpkg_index.owner(file_name);
+    if (package.name.isEmpty())
+        return;
+    QString tooltip = button->toolTip();
+    if (!tooltip.isEmpty())
+        tooltip += "\n";
+    button->setToolTip(tooltip + tr("Package: %1 %2").arg(package.name, package.version));
+    if (button->underMouse() && QToolTip::isVisible())
+        QToolTip::showText(QCursor::pos(), button->toolTip(), button);
+}
+
+void MainWindow::addPendingPackageToolTips()
+{
+    const auto pending = pending_tooltips;
+    pending_tooltips.clear();
+    for (const auto &item : pending)
+        if (item.first) // buttons are recreated on resize and search
+            addPackageToolTip(item.first, item.second);
+}
+
+QIcon MainWindow::findIcon(QString icon_name, const QString &icon_path)
 {
     if (icon_name.isEmpty())
         return QIcon();
@@ -313,6 +384,17 @@ QIcon MainWindow::findIcon(QString icon_name)
     if (QIcon::hasThemeIcon(icon_name))
         return QIcon::fromTheme(icon_name);
 
+    // user icons take precedence over the path resolved by the catalog generator
+    const QString home_icons = QDir::homePath() + "/.local/share/icons/";
+    for (const QString &ext : {".png", ".svg", ".xpm"} ) {
+        QString file = home_icons + icon_name + ext;
+        if (QFileInfo::exists(file))
+            return QIcon(file);
+    }
+    // the icon may have moved since the catalog was generated
+    if (!icon_path.isEmpty() && QFileInfo::exists(icon_path))
+        return QIcon(icon_path);
+
     // Try to find in most obvious places
     QStringList search_paths { QDir::homePath() + "/.local/share/icons/",
                                "/usr/share/pixmaps/",
@@ -341,9 +423,23 @@ QIcon MainWindow::findIcon(QString icon_name)
 
 void MainWindow::btn_clicked()
 {
+    usage.record(sender()->property("file_name").toString());
     this->hide();
-    system(sender()->objectName().toUtf8());
-    this->show();
+    // run without blocking the event loop so the usage flush timer fires while the tool is open
+    auto *tool = new QProcess(this);
+    tool->setProcessChannelMode(QProcess::ForwardedChannels);
+    tool->setInputChannelMode(QProcess::ForwardedInputChannel);
+    connect(tool, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this, [this, tool] {
+        tool->deleteLater();
+        this->show();
+    });
+    connect(tool, &QProcess::errorOccurred, this, [this, tool](QProcess::ProcessError error) {
+        if (error == QProcess::FailedToStart) {
+            tool->deleteLater();
+            this->show();
+        }
+    });
+    tool->start("/bin/sh", {"-c", sender()->objectName()});
 }
 
 void MainWindow::closeEvent(QCloseEvent *)
@@ -355,8 +451,8 @@ void MainWindow::resizeEvent(QResizeEvent *event)
 {
     if (event->oldSize().width() == event->size().width())
         return;
-    int new_count = this->width() / 200;
-    if (this->width() / 200 != col_count) {
+    int new_count = columnCount();
+    if (new_count != col_count) {
         if (new_count > max_elements && col_count == max_elements)
             return;
         col_count = 0;
@@ -492,12 +588,8 @@ void MainWindow::removeXfceOnly(QStringList &list)
 {
     const QStringList list_copy = list;
     for (const QString &file_name : list_copy) {
-        QFile file(file_name);
-        if (!file.open(QFile::Text | QFile::ReadOnly))
-            continue;
-        QString text = file.readAll();
-        file.close();
-        if (text.contains(QLatin1String("OnlyShowIn=XFCE")))
+        const Catalog::Entry *entry = catalog.entry(file_name);
+        if (entry && (entry->flags & Catalog::OnlyXfce))
             list.removeOne(file_name);
     }
 }
@@ -507,12 +599,8 @@ void MainWindow::removeFLUXBOXonly(QStringList &list)
 {
     const QStringList list_copy = list;
     for (const QString &file_name : list_copy) {
-        QFile file(file_name);
-        if (!file.open(QFile::Text | QFile::ReadOnly))
-            continue;
-        QString text = file.readAll();
-        file.close();
-        if (text.contains(QLatin1String("OnlyShowIn=FLUXBOX")))
+        const Catalog::Entry *entry = catalog.entry(file_name);
+        if (entry && (entry->flags & Catalog::OnlyFluxbox))
             list.removeOne(file_name);
     }
 }
@@ -520,15 +608,11 @@ void MainWindow::removeFLUXBOXonly(QStringList &list)
 // When running live remove programs meant only for installed environments and the other way round
 void MainWindow::removeEnvExclusive(QStringList &list, bool live)
 {
-    const QString term = live ? "MX-OnlyInstalled" : "MX-OnlyLive";
+    const Catalog::Flag flag = live ? Catalog::OnlyInstalled : Catalog::OnlyLive;
     const QStringList list_copy = list;
     for (const QString &file_name : list_copy) {
-        QFile file(file_name);
-        if (!file.open(QFile::Text | QFile::ReadOnly))
-            continue;
-        QString text = file.readAll();
-        file.close();
-        if (text.contains(term))
+        const Catalog::Entry *entry = catalog.entry(file_name);
+        if (entry && (entry->flags & flag))
             list.removeOne(file_name);
     }
 }
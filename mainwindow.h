@@ -25,9 +25,15 @@
 
 #include <QMessageBox>
 #include <QMultiMap>
+#include <QPointer>
 #include <QProcess>
 #include <QSettings>
 
+#include "catalog.h"
+#include "dpkgindex.h"
+#include "labelmetrics.h"
+#include "prefetcher.h"
+#include "usagetracker.h"
 #include <flatbutton.h>
 
 namespace Ui {
@@ -45,7 +51,7 @@ public:
     explicit MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
 
-    enum Info {Name, Comment, IconName, Exec, Terminal};
+    enum Info {Name, Comment, IconName, Exec, Category, Terminal, IconPath};
     FlatButton *btn{};
     QMultiMap<QString, QStringList> category_map;
     QMultiMap<QString, QMultiMap<QString, QStringList>> info_map;
@@ -55,14 +61,20 @@ public:
     QStringList software_list;
     QStringList utilities_list;
 
+    void addButton(const QString &file_name, const QStringList &file_info, int &row, int &col, int max);
     void addButtons(const QMultiMap<QString, QMultiMap<QString, QStringList>> &info_map);
+    void addPackageToolTip(FlatButton *button, const QString &file_name);
+    void addPendingPackageToolTips();
+    void addSectionLabel(const QString &text, int &row);
+    int buttonAreaWidth() const;
+    int columnCount() const;
+    int columnWidth(const QStringList &names);
     void hideShowIcon(const QString &file_name, bool hide);
     void readInfo(const QMultiMap<QString, QStringList> &category_map);
     void setConnections();
 
-    QIcon findIcon(QString icon_name);
+    QIcon findIcon(QString icon_name, const QString &icon_path = QString());
     QString getCmdOut(const QString &cmd);
-    QStringList listDesktopFiles(const QString &search_string, const QString &location);
 
 private slots:
     void btn_clicked();
@@ -75,10 +87,20 @@ private slots:
 
 private:
     Ui::MainWindow *ui;
+    Catalog catalog;
+    DpkgIndex dpkg_index {QStringList {"/usr/share/applications/"}};
+    QList<QPair<QPointer<FlatButton>, QString>> pending_tooltips; // hovered before dpkg_index was loaded
+    LabelMetrics label_metrics;
+    Prefetcher prefetcher;
     QSettings settings;
+    UsageTracker usage;
+    int button_padding = -1;
     int col_count = 0;
+    int col_width = 200;
+    int frequent_count = 5;
     int icon_size = 32;
     int max_col = 0;
+    int max_col_width = 320;
     int max_elements = 0;
     void removeEnvExclusive(QStringList &list, bool live);
     void removeFLUXBOXonly(QStringList &list);
@@ -39,12 +39,24 @@ TEMPLATE = app
 DEFINES += QT_DEPRECATED_WARNINGS
 
 SOURCES += main.cpp\
+    catalog.cpp \
+    dpkgindex.cpp \
+    environmentprobe.cpp \
     flatbutton.cpp \
-    mainwindow.cpp
+    labelmetrics.cpp \
+    mainwindow.cpp \
+    prefetcher.cpp \
+    usagetracker.cpp
 
 HEADERS  += \
+    catalog.h \
+    dpkgindex.h \
+    environmentprobe.h \
     flatbutton.h \
+    labelmetrics.h \
     mainwindow.h \
+    prefetcher.h \
+    usagetracker.h \
     version.h
 
 FORMS    += \
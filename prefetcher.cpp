@@ -0,0 +1,301 @@
+/**********************************************************************
+ * Copyright (C) 2021 MX Authors
+ *
+ * Authors: MX Linux <http://mxlinux.org>
+ *
+ * This file is part of MX Tools.
+ *
+ * MX Tools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MX Tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MX Tools.  If not, see <http://www.gnu.org/licenses/>.
+ **********************************************************************/
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QProcess>
+#include <QStandardPaths>
+
+#include <cstring>
+#include <elf.h>
+#include <fcntl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "prefetcher.h"
+
+// from linux/ioprio.h, not exported by glibc
+static const int ioprio_class_idle = 3;
+static const int ioprio_class_shift = 13;
+static const int ioprio_who_process = 1;
+
+Prefetcher::Prefetcher(QObject *parent)
+    : QThread(parent)
+{
+    delay_timer.setSingleShot(true);
+    delay_timer.setInterval(delay);
+    connect(&delay_timer, &QTimer::timeout, this, [this] {
+        QMutexLocker locker(&mutex);
+        pending_command = delayed_command;
+        generation.fetchAndAddOrdered(1);
+        condition.wakeOne();
+    });
+}
+
+Prefetcher::~Prefetcher()
+{
+    {
+        QMutexLocker locker(&mutex);
+        quit = true;
+        generation.fetchAndAddOrdered(1);
+        condition.wakeOne();
+    }
+    wait();
+}
+
+// Stop the pending and in progress work, e.g. when the pointer leaves the button
+void Prefetcher::cancel()
+{
+    delay_timer.stop();
+    QMutexLocker locker(&mutex);
+    pending_command.clear();
+    generation.fetchAndAddOrdered(1);
+}
+
+void Prefetcher::request(const QString &command)
+{
+    if (!isRunning())
+        start(QThread::IdlePriority);
+    cancel();
+    delayed_command = command;
+    delay_timer.start();
+}
+
+void Prefetcher::run()
+{
+    // idle I/O class for this thread (0 = calling thread), so prefetching never competes with real reads
+    syscall(SYS_ioprio_set, ioprio_who_process, 0, ioprio_class_idle << ioprio_class_shift);
+
+    lib_dirs << "/usr/local/lib";
+    const QString conf_dir = "/etc/ld.so.conf.d/";
+    for (const QString &conf : QDir(conf_dir).entryList({"*.conf"}, QDir::Files)) {
+        QFile file(conf_dir + conf);
+        if (!file.open(QFile::ReadOnly | QFile::Text))
+            continue;
+        for (const QByteArray &line : file.readAll().split('\n'))
+            if (line.startsWith('/'))
+                lib_dirs << QString::fromLocal8Bit(line.trimmed());
+    }
+
+    forever {
+        QString command;
+        int gen = 0;
+        {
+            QMutexLocker locker(&mutex);
+            while (!quit && pending_command.isEmpty())
+                condition.wait(&mutex);
+            if (quit)
+                return;
+            command = pending_command;
+            pending_command.clear();
+            gen = generation.loadAcquire();
+        }
+        prefetch(command, gen);
+    }
+}
+
+// Read ahead the command target and everything it loads, stops when a newer request comes in
+void Prefetcher::prefetch(const QString &command, int gen)
+{
+    const QString target = resolveCommand(command);
+    if (target.isEmpty())
+        return;
+
+    // files read ahead earlier are walked again through their cached dependencies,
+    // so a walk cut short by cancel() or max_files resumes on the next request
+    QStringList queue {target};
+    QSet<QString> visited;
+    QString triplet;
+    int count = 0;
+    while (!queue.isEmpty() && generation.loadAcquire() == gen) {
+        const QString path = queue.takeFirst();
+        if (visited.contains(path))
+            continue;
+        visited.insert(path);
+        auto it = dependencies.constFind(path);
+        if (it == dependencies.constEnd()) {
+            if (count >= max_files)
+                break;
+            ++count;
+            QStringList needed;
+            QStringList libs;
+            const bool read = readAhead(path, gen, &needed, &triplet);
+            if (generation.loadAcquire() != gen)
+                break; // cut short, read it again next time
+            if (read) {
+                for (const QString &item : qAsConst(needed)) {
+                    const QString lib = item.startsWith('/') ? item : resolveLibrary(item, triplet);
+                    if (!lib.isEmpty())
+                        libs << lib;
+                }
+            }
+            it = dependencies.insert(path, libs);
+        }
+        for (const QString &lib : it.value())
+            if (!visited.contains(lib))
+                queue << lib;
+    }
+}
+
+// Find the executable in Exec, skipping wrappers, options, variables and field codes
+QString Prefetcher::resolveCommand(const QString &command)
+{
+    static const QSet<QString> wrappers {"env", "gksu", "gksudo", "ionice", "nice", "pkexec", "sh", "bash",
+                                         "su-to-root", "sudo", "x-terminal-emulator"};
+    const QStringList args = QProcess::splitCommand(command);
+    for (const QString &arg : args) {
+        if (arg.startsWith('-') || arg.startsWith('%') || arg.contains('='))
+            continue;
+        if (wrappers.contains(QFileInfo(arg).fileName()))
+            continue;
+        const QString path = arg.startsWith('/') ? arg : QStandardPaths::findExecutable(arg);
+        return QFileInfo(path).canonicalFilePath();
+    }
+    return QString();
+}
+
+// Search the usual library folders for the architecture of the first ELF file seen
+QString Prefetcher::resolveLibrary(const QString &name, const QString &triplet)
+{
+    const QString key = triplet + '/' + name;
+    auto it = lib_cache.constFind(key);
+    if (it != lib_cache.constEnd())
+        return it.value();
+
+    QStringList dirs;
+    if (!triplet.isEmpty())
+        dirs << "/lib/" + triplet << "/usr/lib/" + triplet;
+    dirs << lib_dirs << "/lib" << "/usr/lib";
+    QString path;
+    for (const QString &dir : qAsConst(dirs)) {
+        const QString file = dir + '/' + name;
+        if (QFileInfo::exists(file)) {
+            path = QFileInfo(file).canonicalFilePath();
+            break;
+        }
+    }
+    lib_cache.insert(key, path);
+    return path;
+}
+
+template <typename Ehdr, typename Phdr, typename Dyn>
+static void readNeeded(const uchar *data, qint64 size, QStringList *needed)
+{
+    // true if [offset, offset + length) lies in the file, written so that nothing can wrap around
+    auto inFile = [size](quint64 offset, quint64 length) {
+        return offset <= static_cast<quint64>(size) && length <= static_cast<quint64>(size) - offset;
+    };
+
+    const auto *ehdr = reinterpret_cast<const Ehdr *>(data);
+    if (ehdr->e_phoff == 0 || ehdr->e_phoff % alignof(Phdr) != 0 || ehdr->e_phoff > static_cast<quint64>(size)
+            || ehdr->e_phnum > (static_cast<quint64>(size) - ehdr->e_phoff) / sizeof(Phdr))
+        return;
+    const auto *phdrs = reinterpret_cast<const Phdr *>(data + ehdr->e_phoff);
+
+    // translate a virtual address to a file offset through the PT_LOAD segments
+    auto offsetOf = [&](quint64 addr) -> qint64 {
+        for (int i = 0; i < ehdr->e_phnum; ++i) {
+            const Phdr &ph = phdrs[i];
+            if (ph.p_type == PT_LOAD && addr >= ph.p_vaddr && addr < ph.p_vaddr + ph.p_filesz)
+                return static_cast<qint64>(addr - ph.p_vaddr + ph.p_offset);
+        }
+        return -1;
+    };
+
+    for (int i = 0; i < ehdr->e_phnum; ++i) {
+        const Phdr &ph = phdrs[i];
+        if (ph.p_type == PT_INTERP && inFile(ph.p_offset, ph.p_filesz)) {
+            const char *interp = reinterpret_cast<const char *>(data + ph.p_offset);
+            *needed << QString::fromLocal8Bit(interp, static_cast<int>(qstrnlen(interp, static_cast<uint>(ph.p_filesz))));
+            continue;
+        }
+        if (ph.p_type != PT_DYNAMIC || ph.p_offset % alignof(Dyn) != 0 || !inFile(ph.p_offset, ph.p_filesz))
+            continue;
+        const auto *dyn = reinterpret_cast<const Dyn *>(data + ph.p_offset);
+        const auto *dyn_end = reinterpret_cast<const Dyn *>(data + ph.p_offset + ph.p_filesz);
+        qint64 strtab = -1;
+        for (const Dyn *d = dyn; d + 1 <= dyn_end && d->d_tag != DT_NULL; ++d)
+            if (d->d_tag == DT_STRTAB)
+                strtab = offsetOf(d->d_un.d_ptr);
+        if (strtab < 0 || strtab >= size)
+            return;
+        for (const Dyn *d = dyn; d + 1 <= dyn_end && d->d_tag != DT_NULL; ++d) {
+            if (d->d_tag != DT_NEEDED || d->d_un.d_val >= static_cast<quint64>(size - strtab))
+                continue;
+            const qint64 offset = strtab + static_cast<qint64>(d->d_un.d_val);
+            if (offset >= 0 && offset < size)
+                *needed << QString::fromLocal8Bit(reinterpret_cast<const char *>(data + offset),
+                                                  static_cast<int>(qstrnlen(reinterpret_cast<const char *>(data + offset),
+                                                                            static_cast<uint>(size - offset))));
+        }
+        return;
+    }
+}
+
+// Read the file into the page cache and list what it needs: ELF interpreter and
+// DT_NEEDED libraries, or the #! interpreter of a script
+bool Prefetcher::readAhead(const QString &path, int gen, QStringList *needed, QString *triplet)
+{
+    QFile file(path);
+    if (!file.open(QFile::ReadOnly) || file.size() < 4)
+        return false;
+    const qint64 size = file.size();
+    // in chunks, so a cancel doesn't have to wait for a large library to be read
+    for (qint64 offset = 0; offset < size; offset += readahead_chunk) {
+        if (generation.loadAcquire() != gen)
+            return false;
+        const qint64 length = qMin(readahead_chunk, size - offset);
+        if (readahead(file.handle(), offset, static_cast<size_t>(length)) != 0)
+            posix_fadvise(file.handle(), offset, length, POSIX_FADV_WILLNEED);
+    }
+
+    uchar *data = file.map(0, size);
+    if (!data)
+        return false;
+    if (data[0] == '#' && data[1] == '!') {
+        const QByteArray first_line = QByteArray(reinterpret_cast<const char *>(data), static_cast<int>(qMin<qint64>(size, 256)))
+                .split('\n').first().mid(2).simplified();
+        const QList<QByteArray> args = first_line.split(' ');
+        QString interpreter = QString::fromLocal8Bit(args.first());
+        if (QFileInfo(interpreter).fileName() == QLatin1String("env") && args.size() > 1)
+            interpreter = QStandardPaths::findExecutable(QString::fromLocal8Bit(args.at(1)));
+        if (!interpreter.isEmpty())
+            *needed << QFileInfo(interpreter).canonicalFilePath();
+    } else if (size > EI_NIDENT && memcmp(data, ELFMAG, SELFMAG) == 0) {
+        if (data[EI_CLASS] == ELFCLASS64 && size >= static_cast<qint64>(sizeof(Elf64_Ehdr)))
+            readNeeded<Elf64_Ehdr, Elf64_Phdr, Elf64_Dyn>(data, size, needed);
+        else if (data[EI_CLASS] == ELFCLASS32 && size >= static_cast<qint64>(sizeof(Elf32_Ehdr)))
+            readNeeded<Elf32_Ehdr, Elf32_Phdr, Elf32_Dyn>(data, size, needed);
+        if (triplet->isEmpty()) {
+            const auto machine = reinterpret_cast<const Elf32_Ehdr *>(data)->e_machine; // same offset in both classes
+            switch (machine) {
+            case EM_X86_64: *triplet = "x86_64-linux-gnu"; break;
+            case EM_386: *triplet = "i386-linux-gnu"; break;
+            case EM_AARCH64: *triplet = "aarch64-linux-gnu"; break;
+            case EM_ARM: *triplet = "arm-linux-gnueabihf"; break;
+            default: break;
+            }
+        }
+    }
+    file.unmap(data);
+    return true;
+}
@@ -0,0 +1,79 @@
+/**********************************************************************
+ * Copyright (C) 2021 MX Authors
+ *
+ * Authors: MX Linux <http://mxlinux.org>
+ *
+ * This file is part of MX Tools.
+ *
+ * MX Tools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MX Tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MX Tools.  If not, see <http://www.gnu.org/licenses/>.
+ **********************************************************************/
+
+#ifndef PREFETCHER_H
+#define PREFETCHER_H
+
+#include <QAtomicInt>
+#include <QHash>
+#include <QMutex>
+#include <QSet>
+#include <QStringList>
+#include <QThread>
+#include <QTimer>
+#include <QWaitCondition>
+
+// Warms the page cache for a tool before it is launched: the Exec target, its script interpreter
+// and the shared libraries from the ELF DT_NEEDED entries are read ahead by a low priority thread.
+// Requests are delayed so sweeping the pointer over the buttons doesn't prefetch everything,
+// and a new request or cancel() stops the work in progress.
+class Prefetcher : public QThread
+{
+    Q_OBJECT
+
+public:
+    explicit Prefetcher(QObject *parent = nullptr);
+    ~Prefetcher();
+
+    void cancel();
+    void request(const QString &command);
+
+protected:
+    void run();
+
+private:
+    static constexpr int delay = 150;     // ms of hover/focus before prefetching
+    static constexpr int max_files = 200; // read ahead per request
+    static constexpr qint64 readahead_chunk = 2 * 1024 * 1024; // cancellation is checked between chunks
+
+    // main thread
+    QTimer delay_timer;
+    QString delayed_command;
+
+    // shared, guarded by mutex
+    QMutex mutex;
+    QWaitCondition condition;
+    QString pending_command;
+    bool quit = false;
+    QAtomicInt generation;
+
+    // worker thread only
+    QHash<QString, QString> lib_cache; // "<triplet>/<soname>" -> path, empty if not found
+    QHash<QString, QStringList> dependencies; // files already read ahead -> resolved interpreter and libraries
+    QStringList lib_dirs;
+
+    void prefetch(const QString &command, int gen);
+    bool readAhead(const QString &path, int gen, QStringList *needed, QString *triplet);
+    QString resolveLibrary(const QString &name, const QString &triplet);
+    static QString resolveCommand(const QString &command);
+};
+
+#endif // PREFETCHER_H
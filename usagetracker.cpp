@@ -0,0 +1,148 @@
+/**********************************************************************
+ * Copyright (C) 2021 MX Authors
+ *
+ * Authors: MX Linux <http://mxlinux.org>
+ *
+ * This file is part of MX Tools.
+ *
+ * MX Tools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MX Tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MX Tools.  If not, see <http://www.gnu.org/licenses/>.
+ **********************************************************************/
+
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+
+#include <algorithm>
+#include <cmath>
+
+#include "usagetracker.h"
+
+UsageTracker::UsageTracker(QObject *parent)
+    : QObject(parent)
+{
+    flush_timer.setSingleShot(true);
+    flush_timer.setInterval(2000);
+    connect(&flush_timer, &QTimer::timeout, this, &UsageTracker::flush);
+}
+
+UsageTracker::~UsageTracker()
+{
+    flush();
+}
+
+void UsageTracker::load(const QString &file_name)
+{
+    this->file_name = file_name;
+    reference_time = QDateTime::currentSecsSinceEpoch();
+    scores.clear();
+    torn_tail = false;
+
+    QFile file(file_name);
+    if (!file.open(QFile::ReadOnly))
+        return;
+    const QByteArray data = file.readAll();
+    file.close();
+
+    const QList<QByteArray> lines = data.split('\n');
+    // the last element is empty when the file ends with a newline, otherwise it was torn by a crash
+    torn_tail = !data.isEmpty() && !data.endsWith('\n');
+    const int complete = lines.count() - 1;
+    for (int i = 0; i < complete; ++i) {
+        const QByteArray &line = lines.at(i);
+        const int first = line.indexOf(' ');
+        const int second = line.indexOf(' ', first + 1);
+        if (first <= 0 || second <= first + 1 || second + 1 >= line.size())
+            continue;
+        bool ok_time = false;
+        bool ok_weight = false;
+        const qint64 time = line.left(first).toLongLong(&ok_time);
+        const double weight = line.mid(first + 1, second - first - 1).toDouble(&ok_weight);
+        if (!ok_time || !ok_weight)
+            continue;
+        scores[QString::fromUtf8(line.mid(second + 1))] += weight * weightAt(time);
+    }
+    if (complete > max_lines)
+        compact();
+}
+
+// Buffer the launch, it is written by the flush timer so it never delays the launch
+void UsageTracker::record(const QString &key)
+{
+    if (key.isEmpty())
+        return;
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+    scores[key] += weightAt(now);
+    pending += QByteArray::number(now) + " 1 " + key.toUtf8() + '\n';
+    flush_timer.start();
+}
+
+// Return up to count keys that have been used, highest score first
+QStringList UsageTracker::top(const QStringList &keys, int count) const
+{
+    QStringList ranked;
+    if (count <= 0)
+        return ranked;
+    for (const QString &key : keys)
+        if (scores.value(key) >= min_score && !ranked.contains(key))
+            ranked << key;
+    std::stable_sort(ranked.begin(), ranked.end(), [this](const QString &a, const QString &b) {
+        return scores.value(a) > scores.value(b);
+    });
+    return ranked.mid(0, count);
+}
+
+// Append the pending records with a single write, the file is opened in append mode
+void UsageTracker::flush()
+{
+    flush_timer.stop();
+    if (pending.isEmpty() || file_name.isEmpty())
+        return;
+    QDir().mkpath(QFileInfo(file_name).absolutePath());
+    QFile file(file_name);
+    if (!file.open(QFile::WriteOnly | QFile::Append)) {
+        qWarning() << "Could not write usage file" << file_name;
+        return;
+    }
+    if (torn_tail)
+        pending.prepend('\n');
+    if (file.write(pending) == pending.size()) {
+        pending.clear();
+        torn_tail = false;
+    }
+}
+
+// Rewrite the file with one line per key holding its decayed score
+void UsageTracker::compact()
+{
+    QSaveFile file(file_name);
+    if (!file.open(QFile::WriteOnly))
+        return;
+    QByteArray data;
+    for (auto it = scores.cbegin(); it != scores.cend(); ++it)
+        if (it.value() >= min_score)
+            data += QByteArray::number(reference_time) + ' ' + QByteArray::number(it.value(), 'g', 6) + ' '
+                    + it.key().toUtf8() + '\n';
+    file.write(data);
+    if (file.commit())
+        torn_tail = false;
+}
+
+// Decay factor of a launch at time relative to reference_time
+double UsageTracker::weightAt(qint64 time) const
+{
+    return std::exp2(static_cast<double>(time - reference_time) / half_life);
+}
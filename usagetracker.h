@@ -0,0 +1,64 @@
+/**********************************************************************
+ * Copyright (C) 2021 MX Authors
+ *
+ * Authors: MX Linux <http://mxlinux.org>
+ *
+ * This file is part of MX Tools.
+ *
+ * MX Tools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MX Tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MX Tools.  If not, see <http://www.gnu.org/licenses/>.
+ **********************************************************************/
+
+#ifndef USAGETRACKER_H
+#define USAGETRACKER_H
+
+#include <QHash>
+#include <QObject>
+#include <QStringList>
+#include <QTimer>
+
+// Launch counters with exponential time decay, kept in an append-only file.
+// Each line is "<unix time> <weight> <key>"; launches are buffered and appended in batches by a timer,
+// a torn last line (crash during write) is ignored and the file is compacted when it grows.
+class UsageTracker : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit UsageTracker(QObject *parent = nullptr);
+    ~UsageTracker();
+
+    void load(const QString &file_name);
+    void record(const QString &key);
+    QStringList top(const QStringList &keys, int count) const;
+
+public slots:
+    void flush();
+
+private:
+    static constexpr double half_life = 30 * 24 * 3600; // seconds
+    static constexpr double min_score = 0.05;           // dropped when compacting
+    static constexpr int max_lines = 1000;              // compact when the file has more lines
+
+    QString file_name;
+    QHash<QString, double> scores; // decayed to reference_time
+    QByteArray pending;
+    QTimer flush_timer;
+    qint64 reference_time = 0;
+    bool torn_tail = false;
+
+    void compact();
+    double weightAt(qint64 time) const;
+};
+
+#endif // USAGETRACKER_H